@@ -13,6 +13,8 @@ const unsigned int START_MEMORY = 0x200;
 const unsigned int START_FONT_ADDRESS = 0x50;
 /* Size of font in bytes */
 const unsigned int FONT_SIZE = 80;
+/* Guest addresses wrap around the 4 KiB memory */
+const unsigned int ADDRESS_MASK = 0x0FFF;
 
 /* Initialize Chip8 emulator */
 Chip8::Chip8() : pc(START_MEMORY), randEng(std::chrono::system_clock::now().time_since_epoch().count()),
@@ -51,7 +53,7 @@ Chip8::Chip8() : pc(START_MEMORY), randEng(std::chrono::system_clock::now().time
     table[0xF] = &Chip8::TableF;
 
     /* Load null opcodes into tables that depend on one digit */
-    for (int i = 0; i <= 0xE; ++i) {
+    for (int i = 0; i <= 0xF; ++i) {
         table0[i] = &Chip8::OP_NULL;
         table8[i] = &Chip8::OP_NULL;
         tableE[i] = &Chip8::OP_NULL;
@@ -77,7 +79,7 @@ Chip8::Chip8() : pc(START_MEMORY), randEng(std::chrono::system_clock::now().time
     tableE[0xE] = &Chip8::OP_EX9E;
 
     /* Load null opcodes into table F that depends on two digits */
-    for (int i = 0; i <= 0x65; ++i) {
+    for (int i = 0; i <= 0xFF; ++i) {
         tableF[i] = &Chip8::OP_NULL;
     }
 
@@ -87,12 +89,12 @@ Chip8::Chip8() : pc(START_MEMORY), randEng(std::chrono::system_clock::now().time
     tableF[0x18] = &Chip8::OP_FX18;
     tableF[0x1E] = &Chip8::OP_FX1E;
     tableF[0x29] = &Chip8::OP_FX29;
-    tableF[0x33] = &Chip8::OP_FX33;
-    tableF[0x55] = &Chip8::OP_FX55;
+    tableF[0x33] = &Chip8::OP_FX33<false>;
+    tableF[0x55] = &Chip8::OP_FX55<false>;
     tableF[0x65] = &Chip8::OP_FX65;
 }
 
-/* Load ROM from file and put it into memory */
+/* Load ROM from file and put it into memory, fail if it can't be read or is too big */
 bool Chip8::LoadROM(const char *fileName) {
     /* Open the file in binary mode, go to the end */
     std::ifstream file(fileName, std::ios::binary | std::ios::ate);
@@ -101,6 +103,14 @@ bool Chip8::LoadROM(const char *fileName) {
         /* Get size of the file, go back to the beginning */
         std::streampos size = file.tellg();
         file.seekg(0, std::ios::beg);
+
+        /* Reject files that don't fit into memory after the ROM start */
+        if (size < 0 || size > static_cast<std::streampos>(sizeof(memory) - START_MEMORY)) {
+            file.close();
+            return false;
+        }
+
+
         /* Read the ROM into memory */
         file.read(reinterpret_cast<char*>(&memory[START_MEMORY]), size);
         file.close();
@@ -110,14 +120,59 @@ bool Chip8::LoadROM(const char *fileName) {
     return false;
 }
 
+/* Copy CPU state into the given registers */
+void Chip8::SaveRegisters(Chip8Registers &cpu) const {
+    memcpy(cpu.registers, registers, sizeof(registers));
+    memcpy(cpu.stack, stack, sizeof(stack));
+    cpu.index = index;
+    cpu.pc = pc;
+    cpu.sp = sp;
+    cpu.delayTimer = delayTimer;
+    cpu.soundTimer = soundTimer;
+}
+
+/* Copy the whole emulator state into the given snapshot */
+void Chip8::SaveState(Chip8State &state) const {
+    SaveRegisters(state.cpu);
+    memcpy(state.memory, memory, sizeof(memory));
+    memcpy(state.video, video, sizeof(video));
+}
+
+/* Restore the emulator state from the given snapshot */
+void Chip8::LoadState(const Chip8State &state) {
+    memcpy(registers, state.cpu.registers, sizeof(registers));
+    memcpy(stack, state.cpu.stack, sizeof(stack));
+    index = state.cpu.index;
+    pc = state.cpu.pc;
+    sp = state.cpu.sp;
+    delayTimer = state.cpu.delayTimer;
+    soundTimer = state.cpu.soundTimer;
+    memcpy(memory, state.memory, sizeof(memory));
+    memcpy(video, state.video, sizeof(video));
+
+    /* Restored screen needs to be shown */
+    drawFlag = true;
+}
+
+/* Seed the random number generator, so runs can be repeated */
+void Chip8::Seed(unsigned int seed) {
+    randEng.seed(seed);
+    rand.reset();
+}
+
 /* Clear the screen */
 void Chip8::OP_00E0() {
     /* Set all video bits to 0 */
     memset(video, 0, sizeof(video));
 }
 
-/* Return from subroutine */
+/* Return from subroutine, if the stack is empty mark it as a fault and ignore the instruction */
 void Chip8::OP_00EE() {
+    if (sp == 0) {
+        fault = true;
+        return;
+    }
+
     pc = stack[--sp];
 }
 
@@ -126,8 +181,13 @@ void Chip8::OP_1NNN() {
     pc = opcode & 0x0FFF;
 }
 
-/* Call the subroutine at the given address */
+/* Call the subroutine at the given address, if the stack is full mark it as a fault and ignore the instruction */
 void Chip8::OP_2NNN() {
+    if (sp >= 16) {
+        fault = true;
+        return;
+    }
+
     stack[sp++] = pc;
     pc = opcode & 0x0FFF;
 }
@@ -279,13 +339,22 @@ void Chip8::OP_DXYN() {
 
     /* Run through all the rows */
     for (unsigned int row = 0; row < bytes; ++row) {
+        /* Clip the rows below the bottom edge */
+        if (yPos + row >= VIDEO_HEIGHT)
+            break;
+
         /* Sprite byte, stored at memory indicated by index, increases with row */
-        uint8_t spriteByte = memory[index + row];
+        uint8_t spriteByte = memory[(index + row) & ADDRESS_MASK];
 
         /* Run through every column (sprite width is always 8) */
         for (unsigned int col = 0; col < 8; ++col) {
             /* Get sprite pixel bit by shifting bits based of a column */
             uint8_t spritePixel = spriteByte & (0x80 >> col);
+
+            /* Clip the columns past the right edge */
+            if (xPos + col >= VIDEO_WIDTH)
+                break;
+
             /* Get display pixel from position + row and columns, multiplied by video width
              * (needed for indexing, because it is one-dimensional array) */
             uint32_t* displayPixel = &video[(xPos + col) + (yPos + row) * VIDEO_WIDTH];
@@ -304,13 +373,13 @@ void Chip8::OP_DXYN() {
 
 /* If the key corresponding to value at register's VX is pressed, skip the next instruction */
 void Chip8::OP_EX9E() {
-    if (keys[registers[(opcode & 0x0F00) >> 8]])
+    if (keys[registers[(opcode & 0x0F00) >> 8] & 0xF])
         pc += 2;
 }
 
 /* If the key corresponding to value at register's VX isn't pressed, skip the next instruction */
 void Chip8::OP_EXA1() {
-    if (!keys[registers[(opcode & 0x0F00) >> 8]])
+    if (!keys[registers[(opcode & 0x0F00) >> 8] & 0xF])
         pc += 2;
 }
 
@@ -354,22 +423,34 @@ void Chip8::OP_FX29() {
 }
 
 /* Store binary-coded decimal value of register VX at addresses I, I + 1 and I + 2 */
+template<bool Watched>
 void Chip8::OP_FX33() {
     uint8_t val = registers[(opcode & 0x0F00) >> 8];
 
     /* Go through ones-place, tens-place and hundreds-place. Place them at the right location */
-    for (int i = 2; i >= 0; i--, val /= 10)
-        memory[index + i] = val % 10;
+    for (int i = 2; i >= 0; i--, val /= 10) {
+        uint16_t address = (index + i) & ADDRESS_MASK;
+        memory[address] = val % 10;
+
+        if constexpr (Watched)
+            tracer->CheckWrite(pc - 2, address, memory[address]);
+    }
 }
 
 /* Store the value of registers V0 to VX inclusive in memory starting at address I.
  * Set I to I + X + 1 */
+template<bool Watched>
 void Chip8::OP_FX55() {
     int x = ((opcode & 0x0F00) >> 8);
 
     /* Go through each register from V0 to VX inclusive, insert values from them into memory starting at I */
-    for (uint8_t i = 0; i <= x; i++)
-        memory[index + i] = registers[i];
+    for (uint8_t i = 0; i <= x; i++) {
+        uint16_t address = (index + i) & ADDRESS_MASK;
+        memory[address] = registers[i];
+
+        if constexpr (Watched)
+            tracer->CheckWrite(pc - 2, address, registers[i]);
+    }
 
     /* Set the register I */
     index = index + x + 1;
@@ -383,12 +464,13 @@ void Chip8::OP_FX65() {
     /* Go through each register from V0 to VX inclusive,
      * set their values to memory addresses values starting at I */
     for (uint8_t i = 0; i <= x; i++)
-        registers[i] = memory[index + i];
+        registers[i] = memory[(index + i) & ADDRESS_MASK];
 }
 
-/* Do nothing, that Opcode isn't available */
-void Chip8::OP_NULL()
-{ }
+/* Do nothing, that Opcode isn't available. Mark it as a fault */
+void Chip8::OP_NULL() {
+    fault = true;
+}
 
 /* Use right opcode method from table 0, based off of last digit */
 void Chip8::Table0() {
@@ -410,10 +492,41 @@ void Chip8::TableF() {
     ((*this).*(tableF[opcode & 0x00FF]))();
 }
 
-/* Fetch, decode and execute the instruction, move pc to the next one */
+/* Fetch, decode and execute the instruction using the selected engine variant */
 void Chip8::Cycle() {
+    ((*this).*(cycleFunc))();
+}
+
+/* Switch to the traced engine variant recording into the given tracer, disable tracing on null */
+void Chip8::EnableTrace(Tracer *newTracer) {
+    tracer = newTracer;
+
+    /* Swap the whole engine and memory writing opcodes, so the untraced variant doesn't pay for any checks */
+    if (tracer) {
+        cycleFunc = &Chip8::Execute<true>;
+        tableF[0x33] = &Chip8::OP_FX33<true>;
+        tableF[0x55] = &Chip8::OP_FX55<true>;
+    }
+    else {
+        cycleFunc = &Chip8::Execute<false>;
+        tableF[0x33] = &Chip8::OP_FX33<false>;
+        tableF[0x55] = &Chip8::OP_FX55<false>;
+    }
+}
+
+/* Latch the key state used by the following cycles */
+void Chip8::LatchKeys(const uint8_t *newKeys) {
+    memcpy(keys, newKeys, sizeof(keys));
+}
+
+/* Fetch, decode and execute the instruction, move pc to the next one */
+template<bool Traced>
+void Chip8::Execute() {
+    /* Address of the executed instruction */
+    uint16_t instructionPc = pc;
+
     /* Fetch the opcode */
-    opcode = (memory[pc] << 8) | memory[pc + 1];
+    opcode = (memory[pc & ADDRESS_MASK] << 8) | memory[(pc + 1) & ADDRESS_MASK];
 
     /* Move to the next instruction */
     pc += 2;
@@ -421,6 +534,11 @@ void Chip8::Cycle() {
     /* Decode, execute the instruction based of the first digit */
     ((*this).*(table[(opcode & 0xF000) >> 12]))();
 
+    /* Record the executed instruction with registers it could have touched */
+    if constexpr (Traced)
+        tracer->Record(instructionPc, opcode, index, sp, registers[(opcode & 0x0F00) >> 8],
+                       registers[(opcode & 0x00F0) >> 4], registers[0xF]);
+
     /* If delay timer is on, decrement it */
     if (delayTimer > 0)
         --delayTimer;
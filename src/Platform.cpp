@@ -4,12 +4,39 @@
 
 #include <cstdio>
 #include "includes/Platform.h"
+#include <array>
+
+/* Keyboard keys of the hex keypad, position is the Chip-8 key */
+static constexpr SDL_Scancode realKeys[16] = {
+        SDL_SCANCODE_X,
+        SDL_SCANCODE_1, SDL_SCANCODE_2, SDL_SCANCODE_3,
+        SDL_SCANCODE_Q, SDL_SCANCODE_W, SDL_SCANCODE_E,
+        SDL_SCANCODE_A, SDL_SCANCODE_S, SDL_SCANCODE_D,
+        SDL_SCANCODE_Z, SDL_SCANCODE_C, SDL_SCANCODE_4,
+        SDL_SCANCODE_R, SDL_SCANCODE_F, SDL_SCANCODE_V
+};
+
+/* Value of scancodes that aren't mapped to any Chip-8 key */
+static constexpr uint8_t NO_KEY = 0xFF;
+
+/* Build lookup table from scancode to Chip-8 key */
+static constexpr std::array<uint8_t, SDL_NUM_SCANCODES> BuildKeyMap() {
+    std::array<uint8_t, SDL_NUM_SCANCODES> map { };
+    for (uint8_t& key : map)
+        key = NO_KEY;
+    for (uint8_t i = 0; i <= 0xF; ++i)
+        map[realKeys[i]] = i;
+    return map;
+}
+
+/* Chip-8 key of each scancode */
+static constexpr std::array<uint8_t, SDL_NUM_SCANCODES> keyMap = BuildKeyMap();
 
 /* Initialize platform */
 Platform::Platform(const char *title, int width, int height,
-                   int textureWidth, int textureHeight) {
-    /* Initialize video */
-    if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
+                   int textureWidth, int textureHeight, bool vsync) {
+    /* Initialize only video (with events), other subsystems aren't used and slow down the startup */
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         printf("ERROR: SDL couldn't be initialized! SDL_Error: %s\n", SDL_GetError());
         std::exit(EXIT_FAILURE);
     }
@@ -22,8 +49,8 @@ Platform::Platform(const char *title, int width, int height,
         std::exit(EXIT_FAILURE);
     }
 
-    /* Create renderer, initialize it with certain logical size */
-    renderer = SDL_CreateRenderer(window, -1, 0);
+    /* Create renderer, with vsync presenting waits for the host display. Initialize it with certain logical size */
+    renderer = SDL_CreateRenderer(window, -1, vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
     SDL_RenderSetLogicalSize(renderer, width, height);
 
     /* Initialize texture */
@@ -53,7 +80,7 @@ void Platform::Update(const void *buffer, int pitch) {
     SDL_RenderPresent(renderer);
 }
 
-/* Process given keys */
+/* Process pending events, update state of the given keys. Called once per frame */
 bool Platform::ProcessInput(uint8_t *keys) {
     /* Quit flag */
     bool quit = false;
@@ -61,26 +88,19 @@ bool Platform::ProcessInput(uint8_t *keys) {
     /* Poll event */
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
-        /* If certain key is pressed, set the correct one to pressed */
-        if (event.type == SDL_KEYDOWN) {
-            if (event.key.keysym.sym == SDLK_ESCAPE) {
+        /* If certain key is pressed or released, set the correct one to its state */
+        if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+            SDL_Scancode scancode = event.key.keysym.scancode;
+
+            if (scancode == SDL_SCANCODE_ESCAPE && event.type == SDL_KEYDOWN) {
                 quit = true;
                 break;
             }
-            else {
-                for (int i = 0; i < 0xF; ++i) {
-                    if (event.key.keysym.sym == realKeys[i])
-                        keys[i] = 1;
-                }
-            }
-        }
 
-        /* If certain key isn't pressed anymore, set the correct one to up */
-        else if (event.type == SDL_KEYUP) {
-            for (int i = 0; i < 0xF; ++i) {
-                if (event.key.keysym.sym == realKeys[i])
-                    keys[i] = 0;
-            }
+            /* Look up the Chip-8 key, skip unmapped ones */
+            uint8_t key = keyMap[scancode];
+            if (key != NO_KEY)
+                keys[key] = event.type == SDL_KEYDOWN;
         }
 
         /* If user requested quiting, set the quit flag to true */
@@ -0,0 +1,288 @@
+#include "includes/Server.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* Create the listening socket and the shared memory segment for framebuffers */
+Server::Server(const char *socketPath, const char *shmName) : socketPath(socketPath), shmName(shmName) {
+    /* Create shared memory segment big enough for framebuffers of all sessions */
+    int shmFd = shm_open(shmName, O_CREAT | O_RDWR, 0644);
+    if (shmFd == -1 || ftruncate(shmFd, sizeof(SharedFrames)) == -1) {
+        printf("ERROR: Shared memory couldn't be created! Error: %s\n", strerror(errno));
+        std::exit(EXIT_FAILURE);
+    }
+
+    /* Map it, descriptor isn't needed after that */
+    void* mapped = mmap(nullptr, sizeof(SharedFrames), PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+    close(shmFd);
+    if (mapped == MAP_FAILED) {
+        printf("ERROR: Shared memory couldn't be mapped! Error: %s\n", strerror(errno));
+        std::exit(EXIT_FAILURE);
+    }
+
+    /* Construct the frames in place, so the sequences start cleared */
+    frames = new (mapped) SharedFrames();
+    frames->sessions = MAX_SESSIONS;
+    frames->width = VIDEO_WIDTH;
+    frames->height = VIDEO_HEIGHT;
+
+    /* Create Unix domain socket, remove the one left by previous run */
+    sockaddr_un address { };
+    address.sun_family = AF_UNIX;
+    if (this->socketPath.size() >= sizeof(address.sun_path)) {
+        printf("ERROR: Socket path is too long!\n");
+        std::exit(EXIT_FAILURE);
+    }
+    strcpy(address.sun_path, socketPath);
+    unlink(socketPath);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd == -1 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+        || listen(listenFd, 16) == -1) {
+        printf("ERROR: Socket couldn't be created! Error: %s\n", strerror(errno));
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+/* Cleanup */
+Server::~Server() {
+    /* Disconnect all clients */
+    for (int client : clients)
+        close(client);
+
+    /* Close and remove the socket */
+    close(listenFd);
+    unlink(socketPath.c_str());
+
+    /* Unmap and remove the shared memory segment */
+    munmap(frames, sizeof(SharedFrames));
+    shm_unlink(shmName.c_str());
+}
+
+/* Serve clients until shutdown is requested */
+void Server::Run() {
+    std::vector<pollfd> fds;
+
+    while (!quit) {
+        /* Wait for new connections and requests of connected clients */
+        fds.clear();
+        fds.push_back({ listenFd, POLLIN, 0 });
+        for (int client : clients)
+            fds.push_back({ client, POLLIN, 0 });
+
+        if (poll(fds.data(), fds.size(), -1) == -1) {
+            if (errno == EINTR)
+                continue;
+            printf("ERROR: Poll failed! Error: %s\n", strerror(errno));
+            return;
+        }
+
+        /* Go through clients from the last one, so disconnected ones can be removed in place */
+        for (size_t i = fds.size() - 1; i > 0; --i) {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                if (!Receive(i - 1)) {
+                    close(clients[i - 1]);
+                    clients.erase(clients.begin() + static_cast<long>(i - 1));
+                    buffers.erase(buffers.begin() + static_cast<long>(i - 1));
+                }
+            }
+        }
+
+        /* Accept new client */
+        if (fds[0].revents & POLLIN)
+            Accept();
+    }
+}
+
+/* Accept waiting client */
+void Server::Accept() {
+    int client = accept(listenFd, nullptr, nullptr);
+    if (client == -1)
+        return;
+
+    clients.push_back(client);
+    buffers.emplace_back();
+}
+
+/* Read data from the client, execute every complete line.
+ * Return false if client disconnected or its line is too long */
+bool Server::Receive(size_t client) {
+    char data[4096];
+    ssize_t size = recv(clients[client], data, sizeof(data), 0);
+    if (size <= 0)
+        return false;
+
+    std::string& buffer = buffers[client];
+    buffer.append(data, static_cast<size_t>(size));
+
+    /* Execute each line, answer with a single line */
+    size_t end;
+    while ((end = buffer.find('\n')) != std::string::npos) {
+        std::string reply = Execute(buffer.substr(0, end)) + "\n";
+        buffer.erase(0, end + 1);
+
+        if (send(clients[client], reply.data(), reply.size(), MSG_NOSIGNAL) == -1)
+            return false;
+    }
+
+    /* Drop the client if it keeps sending without ending the line */
+    return buffer.size() <= MAX_LINE_LENGTH;
+}
+
+/* Get the open session by its id, null if there is none */
+Session *Server::GetSession(unsigned int id) {
+    if (id >= MAX_SESSIONS)
+        return nullptr;
+    return sessions[id].get();
+}
+
+/* Write the framebuffer of the session into shared memory, following the seqlock protocol */
+void Server::Publish(unsigned int id, const uint32_t *video, uint64_t frame) {
+    SharedFrame& shared = frames->frames[id];
+    uint64_t sequence = shared.sequence.load(std::memory_order_relaxed);
+
+    /* Mark the frame as being written before any data changes */
+    shared.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    shared.frame = frame;
+    if (video)
+        memcpy(shared.video, video, sizeof(shared.video));
+    else
+        memset(shared.video, 0, sizeof(shared.video));
+
+    /* Mark the frame complete, data written above becomes visible before it */
+    shared.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/* Execute a single request line, return the reply */
+std::string Server::Execute(const std::string &line) {
+    std::istringstream input(line);
+    std::string command;
+    input >> command;
+
+    /* Open new session with the given ROM, answer with the session id */
+    if (command == "OPEN") {
+        std::string rom;
+        input >> rom;
+
+        for (unsigned int id = 0; id < MAX_SESSIONS; ++id) {
+            if (!sessions[id]) {
+                std::unique_ptr<Session> session = std::make_unique<Session>();
+                if (!session->emu.LoadROM(rom.c_str()))
+                    return "ERR ROM couldn't be read or is too big";
+
+                sessions[id] = std::move(session);
+                Publish(id, sessions[id]->emu.video, 0);
+                return "OK " + std::to_string(id);
+            }
+        }
+        return "ERR No free session";
+    }
+
+    /* Stop the server */
+    if (command == "SHUTDOWN") {
+        quit = true;
+        return "OK";
+    }
+
+    /* Every other command works on an open session */
+    unsigned int id = MAX_SESSIONS;
+    input >> id;
+    Session* session = input.fail() ? nullptr : GetSession(id);
+    if (!session)
+        return "ERR Invalid session";
+
+    /* Replace the session emulator with a new one running the given ROM */
+    if (command == "LOAD") {
+        std::string rom;
+        input >> rom;
+
+        std::unique_ptr<Session> fresh = std::make_unique<Session>();
+        if (!fresh->emu.LoadROM(rom.c_str()))
+            return "ERR ROM couldn't be read or is too big";
+
+        sessions[id] = std::move(fresh);
+        Publish(id, sessions[id]->emu.video, 0);
+        return "OK";
+    }
+
+    /* Emulate the given number of frames, publish the framebuffer, answer with the frame number */
+    if (command == "STEP") {
+        /* Step one frame if the count is left out */
+        unsigned int count = 1;
+        if (!(input >> std::ws).eof() && !(input >> count))
+            return "ERR Invalid frame count";
+        if (count > MAX_STEP_FRAMES)
+            return "ERR Too many frames, at most " + std::to_string(MAX_STEP_FRAMES);
+
+        uint64_t cycles = static_cast<uint64_t>(count) * CYCLES_PER_FRAME;
+        for (uint64_t i = 0; i < cycles; ++i)
+            session->emu.Cycle();
+        session->emu.drawFlag = false;
+
+        uint64_t frame = frames->frames[id].frame + count;
+        Publish(id, session->emu.video, frame);
+        return "OK " + std::to_string(frame);
+    }
+
+    /* Set pressed keys from the hex mask, bit N is key N */
+    if (command == "KEYS") {
+        unsigned int mask = 0;
+        if (!(input >> std::hex >> mask) || mask > 0xFFFF)
+            return "ERR Invalid key mask";
+
+        uint8_t keys[16];
+        for (int i = 0; i < 16; ++i)
+            keys[i] = (mask >> i) & 1;
+        session->emu.LatchKeys(keys);
+        return "OK";
+    }
+
+    /* Save the session state */
+    if (command == "SNAPSHOT") {
+        session->emu.SaveState(session->snapshot);
+        session->hasSnapshot = true;
+        return "OK";
+    }
+
+    /* Go back to the saved session state */
+    if (command == "RESTORE") {
+        if (!session->hasSnapshot)
+            return "ERR No snapshot";
+
+        session->emu.LoadState(session->snapshot);
+        return "OK";
+    }
+
+    /* Answer with the CPU state */
+    if (command == "STATE") {
+        Chip8Registers cpu { };
+        session->emu.SaveRegisters(cpu);
+
+        char reply[128];
+        int length = snprintf(reply, sizeof(reply), "OK PC %03X I %03X SP %u DT %u ST %u V",
+                              cpu.pc, cpu.index, cpu.sp, cpu.delayTimer, cpu.soundTimer);
+        for (uint8_t value : cpu.registers)
+            length += snprintf(reply + length, sizeof(reply) - length, " %02X", value);
+        return reply;
+    }
+
+    /* Close the session */
+    if (command == "CLOSE") {
+        sessions[id].reset();
+        Publish(id, nullptr, 0);
+        return "OK";
+    }
+
+    return "ERR Unknown command";
+}
@@ -0,0 +1,64 @@
+#include "includes/SpeedControl.h"
+#include <algorithm>
+#include <climits>
+#include <thread>
+
+/* Time of a single host frame, uncapped mode emulates as many frames as fit in it */
+const std::chrono::microseconds HOST_FRAME(16667);
+
+/* Longest time the emulation can catch up at once, if it falls further behind the rest is dropped */
+const std::chrono::milliseconds MAX_CATCH_UP(250);
+
+/* Initialize the controller with the normal frame rate and speed multiplier (0 = as fast as possible) */
+SpeedControl::SpeedControl(double frameRate, double multiplier)
+        : targetRate(frameRate * multiplier), start(Clock::now()), batchStart(start)
+{ }
+
+/* Get the number of frames that should be emulated now to keep the target speed */
+unsigned int SpeedControl::FramesDue() {
+    batchStart = Clock::now();
+
+    /* Uncapped mode runs the batch measured to fill one host frame */
+    if (targetRate <= 0)
+        return batch;
+
+    /* Frames that should have been emulated until now */
+    std::chrono::duration<double> elapsed = batchStart - start;
+    auto due = static_cast<unsigned long long>(elapsed.count() * targetRate);
+
+    /* If the host is too slow to catch up, drop the time behind, so the emulation doesn't spiral */
+    auto maxFrames = static_cast<unsigned long long>(
+            std::chrono::duration<double>(MAX_CATCH_UP).count() * targetRate) + 1;
+    if (due > frames + maxFrames)
+        frames = due - maxFrames;
+
+    /* Saturate, so the count fits into the result */
+    if (due <= frames)
+        return 0;
+    return static_cast<unsigned int>(std::min<unsigned long long>(due - frames, UINT_MAX));
+}
+
+/* Count emulated frames, in uncapped mode adjust the batch to the time emulating them took.
+ * Called before presenting, so slow presenting doesn't shrink the batch */
+void SpeedControl::FramesDone(unsigned int count) {
+    frames += count;
+
+    if (targetRate > 0 || count == 0)
+        return;
+
+    /* Scale the batch towards one host frame, change it at most twice at once to stay stable */
+    auto took = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - batchStart);
+    if (took < HOST_FRAME / 2)
+        batch *= 2;
+    else if (took > HOST_FRAME && batch > 1)
+        batch /= 2;
+}
+
+/* Sleep until the next frame is due, doesn't sleep in uncapped mode */
+void SpeedControl::Wait() {
+    if (targetRate <= 0)
+        return;
+
+    std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>((frames + 1) / targetRate)));
+}
@@ -0,0 +1,48 @@
+#include "includes/Tracer.h"
+#include <cstdio>
+#include <fstream>
+
+/* Save the executed instruction into the ring buffer, overwriting the oldest one */
+void Tracer::Record(uint16_t pc, uint16_t opcode, uint16_t index, uint8_t sp,
+                    uint8_t vx, uint8_t vy, uint8_t vf) {
+    TraceEntry& entry = entries[count++ & (TRACE_SIZE - 1)];
+
+    entry.pc = pc;
+    entry.opcode = opcode;
+    entry.index = index;
+    entry.sp = sp;
+    entry.vx = vx;
+    entry.vy = vy;
+    entry.vf = vf;
+}
+
+/* Report writes to the given memory address */
+void Tracer::AddWatchpoint(uint16_t address) {
+    watchpoints.set(address & 0x0FFF);
+}
+
+/* Stop reporting writes to the given memory address */
+void Tracer::RemoveWatchpoint(uint16_t address) {
+    watchpoints.reset(address & 0x0FFF);
+}
+
+/* Print the write that hit the watchpoint */
+void Tracer::OnWatchpoint(uint16_t pc, uint16_t address, uint8_t value) {
+    fprintf(stderr, "WATCH: PC %03X wrote %02X at %03X\n", pc, value, address);
+}
+
+/* Write recorded instructions from the oldest to the newest into the binary file */
+bool Tracer::Dump(const char *fileName) const {
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open())
+        return false;
+
+    /* If the buffer wrapped around, the oldest entry is the next one to be overwritten */
+    uint64_t first = count > TRACE_SIZE ? count - TRACE_SIZE : 0;
+    for (uint64_t i = first; i < count; ++i)
+        file.write(reinterpret_cast<const char*>(&entries[i & (TRACE_SIZE - 1)]), sizeof(TraceEntry));
+
+    file.close();
+    return true;
+}
@@ -0,0 +1,158 @@
+#include "includes/Verifier.h"
+#include <cstdio>
+#include <cstring>
+
+/* Number of frames the random key state is held for */
+const unsigned int KEY_HOLD_FRAMES = 8;
+
+/* Load the ROM into both engines, seed them the same way, switch the candidate to its engine */
+Verifier::Verifier(const char *rom, unsigned int seed) : inputEng(seed) {
+    loaded = reference.LoadROM(rom) && candidate.LoadROM(rom);
+
+    reference.Seed(seed);
+    candidate.Seed(seed);
+
+    /* Candidate engine, replace here to verify a different one */
+    candidate.EnableTrace(&tracer);
+}
+
+/* Emulate the given number of frames in lockstep, stop on the first divergence.
+ * Whole state is compared after every instruction if requested, otherwise after every frame */
+VerifyResult Verifier::Run(uint64_t frames, bool everyInstruction) {
+    VerifyResult result;
+    if (!loaded) {
+        result.diff = "ROM couldn't be read";
+        return result;
+    }
+
+    uint8_t keys[16] { };
+
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        /* Change the pressed keys every few frames, at most one key at once like a player would */
+        if (frame % KEY_HOLD_FRAMES == 0) {
+            memset(keys, 0, sizeof(keys));
+            unsigned int key = inputEng() % 32;
+            if (key < 16)
+                keys[key] = 1;
+        }
+
+        reference.LatchKeys(keys);
+        candidate.LatchKeys(keys);
+
+        for (unsigned int i = 0; i < CYCLES_PER_FRAME; ++i) {
+            reference.Cycle();
+            candidate.Cycle();
+            ++result.cycles;
+
+            if (everyInstruction) {
+                result.diff = Compare();
+                if (!result.diff.empty())
+                    return result;
+            }
+        }
+
+        if (!everyInstruction) {
+            result.diff = Compare();
+            if (!result.diff.empty())
+                return result;
+        }
+    }
+
+    result.passed = true;
+    return result;
+}
+
+/* Describe differences between the whole states of the engines, empty if there are none */
+std::string Verifier::Compare() {
+    return CompareRegisters() + CompareFrame() + CompareFlags();
+}
+
+/* Describe differences between fault and draw flags of the engines, empty if there are none.
+ * Flags are cleared afterwards, so each comparison checks only what was raised since the last one */
+std::string Verifier::CompareFlags() {
+    std::string diff;
+
+    if (reference.fault != candidate.fault)
+        diff += reference.fault ? " fault 1 != 0;" : " fault 0 != 1;";
+    if (reference.drawFlag != candidate.drawFlag)
+        diff += reference.drawFlag ? " draw 1 != 0;" : " draw 0 != 1;";
+
+    reference.fault = candidate.fault = false;
+    reference.drawFlag = candidate.drawFlag = false;
+    return diff;
+}
+
+/* Describe differences between CPU states of the engines, empty if there are none */
+std::string Verifier::CompareRegisters() const {
+    Chip8Registers ref { };
+    Chip8Registers cand { };
+    reference.SaveRegisters(ref);
+    candidate.SaveRegisters(cand);
+
+    /* Fast path taken on every instruction while engines agree */
+    if (ref.pc == cand.pc && ref.index == cand.index && ref.sp == cand.sp
+        && ref.delayTimer == cand.delayTimer && ref.soundTimer == cand.soundTimer
+        && memcmp(ref.registers, cand.registers, sizeof(ref.registers)) == 0
+        && memcmp(ref.stack, cand.stack, sizeof(ref.stack)) == 0)
+        return { };
+
+    std::string diff;
+    char line[64];
+
+    /* Add a single differing value to the description */
+    auto compare = [&](const std::string& name, unsigned int refValue, unsigned int candValue) {
+        if (refValue != candValue) {
+            snprintf(line, sizeof(line), " %s %X != %X;", name.c_str(), refValue, candValue);
+            diff += line;
+        }
+    };
+
+    compare("PC", ref.pc, cand.pc);
+    compare("I", ref.index, cand.index);
+    compare("SP", ref.sp, cand.sp);
+    compare("DT", ref.delayTimer, cand.delayTimer);
+    compare("ST", ref.soundTimer, cand.soundTimer);
+
+    /* Registers and stack entries are named by their hex digit */
+    const char* digits = "0123456789ABCDEF";
+    for (int i = 0; i < 16; ++i) {
+        compare(std::string("V") + digits[i], ref.registers[i], cand.registers[i]);
+        compare(std::string("S") + digits[i], ref.stack[i], cand.stack[i]);
+    }
+
+    return diff;
+}
+
+/* Describe the first differences between memory and screen of the engines, empty if there are none */
+std::string Verifier::CompareFrame() {
+    reference.SaveState(referenceState);
+    candidate.SaveState(candidateState);
+
+    std::string diff;
+    char line[64];
+
+    /* Report only the first differing address */
+    if (memcmp(referenceState.memory, candidateState.memory, sizeof(referenceState.memory)) != 0) {
+        for (unsigned int i = 0; i < sizeof(referenceState.memory); ++i) {
+            if (referenceState.memory[i] != candidateState.memory[i]) {
+                snprintf(line, sizeof(line), " memory %03X %02X != %02X;",
+                         i, referenceState.memory[i], candidateState.memory[i]);
+                diff += line;
+                break;
+            }
+        }
+    }
+
+    /* Report only the first differing pixel */
+    if (memcmp(referenceState.video, candidateState.video, sizeof(referenceState.video)) != 0) {
+        for (unsigned int i = 0; i < VIDEO_WIDTH * VIDEO_HEIGHT; ++i) {
+            if (referenceState.video[i] != candidateState.video[i]) {
+                snprintf(line, sizeof(line), " pixel (%u, %u) differs;", i % VIDEO_WIDTH, i / VIDEO_WIDTH);
+                diff += line;
+                break;
+            }
+        }
+    }
+
+    return diff;
+}
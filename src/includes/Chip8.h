@@ -8,9 +8,32 @@
 #include <cstdint>
 #include <chrono>
 #include <random>
+#include "Tracer.h"
 
 const unsigned int VIDEO_WIDTH = 64;
 const unsigned int VIDEO_HEIGHT = 32;
+/* Number of cycles emulated in one frame (60 frames per second at the default delay) */
+const unsigned int CYCLES_PER_FRAME = 9;
+
+/* CPU state of the emulator */
+struct Chip8Registers
+{
+    uint8_t registers[16];
+    uint16_t stack[16];
+    uint16_t index;
+    uint16_t pc;
+    uint8_t sp;
+    uint8_t delayTimer;
+    uint8_t soundTimer;
+};
+
+/* Whole state of the emulator, used for snapshots */
+struct Chip8State
+{
+    Chip8Registers cpu;
+    uint8_t memory[4096];
+    uint32_t video[VIDEO_WIDTH * VIDEO_HEIGHT];
+};
 
 class Chip8
 {
@@ -19,8 +42,17 @@ public:
 
     bool LoadROM(const char* fileName);
     void Cycle();
+    void EnableTrace(Tracer* newTracer);
+    void LatchKeys(const uint8_t* newKeys);
+
+    void SaveRegisters(Chip8Registers& cpu) const;
+    void SaveState(Chip8State& state) const;
+    void LoadState(const Chip8State& state);
+    void Seed(unsigned int seed);
 
 private:
+    template<bool Traced> void Execute();
+
     void OP_00E0();
     void OP_00EE();
     void OP_1NNN();
@@ -52,8 +84,8 @@ private:
     void OP_FX18();
     void OP_FX1E();
     void OP_FX29();
-    void OP_FX33();
-    void OP_FX55();
+    template<bool Watched> void OP_FX33();
+    template<bool Watched> void OP_FX55();
     void OP_FX65();
     void OP_NULL();
 
@@ -63,9 +95,10 @@ private:
     void TableF();
 
 public:
-    uint32_t video[64 * 32] { };
-    uint8_t keys[16] { };
+    uint32_t video[VIDEO_WIDTH * VIDEO_HEIGHT] { };
     bool drawFlag = false;
+    /* Set when an unknown opcode was executed or the stack overflowed */
+    bool fault = false;
 
 private:
     std::default_random_engine randEng;
@@ -81,13 +114,23 @@ private:
     uint8_t soundTimer = 0;
     uint16_t opcode = 0;
 
+    /* Key state latched by the frontend, stays the same until the next latch */
+    uint8_t keys[16] { };
+
+    /* Trace recorder, only used by the traced engine variant */
+    Tracer* tracer = nullptr;
+
     typedef void (Chip8::*Chip8Func)();
 
+    /* Engine variant that executes the cycle */
+    Chip8Func cycleFunc = &Chip8::Execute<false>;
+
     Chip8Func table[0xF + 1] { };
-    Chip8Func table0[0xE + 1] { };
-    Chip8Func table8[0xE + 1] { };
-    Chip8Func tableE[0xE + 1] { };
-    Chip8Func tableF[0x65 + 1] { };
+    /* Sub tables cover every value of the digits they are indexed by, unknown ones run OP_NULL */
+    Chip8Func table0[0xF + 1] { };
+    Chip8Func table8[0xF + 1] { };
+    Chip8Func tableE[0xF + 1] { };
+    Chip8Func tableF[0xFF + 1] { };
 };
 
 
@@ -11,7 +11,7 @@
 class Platform
 {
 public:
-    Platform(const char* title, int width, int height, int textureWidth, int textureHeight);
+    Platform(const char* title, int width, int height, int textureWidth, int textureHeight, bool vsync = false);
     ~Platform();
 
     void Update(void const* buffer, int pitch);
@@ -21,14 +21,6 @@ private:
     SDL_Window* window { };
     SDL_Renderer* renderer { };
     SDL_Texture* texture { };
-    static constexpr int realKeys[16] = {
-            SDLK_x,
-            SDLK_1, SDLK_2, SDLK_3,
-            SDLK_q, SDLK_w, SDLK_e,
-            SDLK_a, SDLK_s, SDLK_d,
-            SDLK_z, SDLK_c, SDLK_4,
-            SDLK_r, SDLK_f, SDLK_v
-    };
 };
 
 
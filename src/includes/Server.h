@@ -0,0 +1,83 @@
+#ifndef CHIP8_EMULATOR_SERVER_H
+#define CHIP8_EMULATOR_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Chip8.h"
+
+/* Maximum number of sessions hosted at once */
+const unsigned int MAX_SESSIONS = 64;
+
+/* Maximum length of a request line, clients sending longer ones are dropped */
+const size_t MAX_LINE_LENGTH = 4096;
+
+/* Maximum number of frames emulated by one STEP, keeps other clients from waiting too long */
+const unsigned int MAX_STEP_FRAMES = 3600;
+
+/* Framebuffer of one session in the shared memory segment.
+ * Published with a seqlock, clients read it as follows:
+ * 1. Load sequence with acquire ordering, if it is odd the frame is being written, start again.
+ * 2. Read frame and video (copy them, or use them in place).
+ * 3. Issue an acquire fence, load sequence again. If it changed, the read may be torn, start again */
+struct SharedFrame
+{
+    /* Odd while the server writes the frame, even once it is complete */
+    std::atomic<uint64_t> sequence;
+    /* Number of the last frame copied into video, increased after every step */
+    uint64_t frame;
+    uint32_t video[VIDEO_WIDTH * VIDEO_HEIGHT];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared frame sequence has to be lock free");
+
+/* Layout of the shared memory segment, clients map it read-only */
+struct SharedFrames
+{
+    uint32_t sessions;
+    uint32_t width;
+    uint32_t height;
+    SharedFrame frames[MAX_SESSIONS];
+};
+
+/* Emulator session hosted by the server */
+struct Session
+{
+    Chip8 emu;
+    Chip8State snapshot { };
+    bool hasSnapshot = false;
+};
+
+class Server
+{
+public:
+    Server(const char* socketPath, const char* shmName);
+    ~Server();
+
+    void Run();
+
+private:
+    void Accept();
+    bool Receive(size_t client);
+    std::string Execute(const std::string& line);
+    Session* GetSession(unsigned int id);
+    void Publish(unsigned int id, const uint32_t* video, uint64_t frame);
+
+private:
+    std::string socketPath;
+    std::string shmName;
+    int listenFd = -1;
+    SharedFrames* frames = nullptr;
+    bool quit = false;
+
+    /* Connected clients with their not yet complete lines */
+    std::vector<int> clients;
+    std::vector<std::string> buffers;
+
+    std::unique_ptr<Session> sessions[MAX_SESSIONS];
+};
+
+
+#endif //CHIP8_EMULATOR_SERVER_H
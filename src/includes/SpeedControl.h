@@ -0,0 +1,35 @@
+#ifndef CHIP8_EMULATOR_SPEEDCONTROL_H
+#define CHIP8_EMULATOR_SPEEDCONTROL_H
+
+#include <chrono>
+
+/* Range of supported speed multipliers, apart from 0 that runs as fast as possible */
+const double MIN_SPEED = 1.0 / 64;
+const double MAX_SPEED = 1024;
+
+class SpeedControl
+{
+public:
+    SpeedControl(double frameRate, double multiplier);
+
+    unsigned int FramesDue();
+    void FramesDone(unsigned int count);
+    void Wait();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    /* Emulated frames per second, 0 when running as fast as possible */
+    double targetRate;
+
+    /* Point from which the frames are counted and number of frames emulated since then */
+    Clock::time_point start;
+    unsigned long long frames = 0;
+
+    /* Uncapped mode: frames emulated per host frame, adjusted to the measured speed */
+    unsigned int batch = 1;
+    Clock::time_point batchStart;
+};
+
+
+#endif //CHIP8_EMULATOR_SPEEDCONTROL_H
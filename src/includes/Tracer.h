@@ -0,0 +1,51 @@
+#ifndef CHIP8_EMULATOR_TRACER_H
+#define CHIP8_EMULATOR_TRACER_H
+
+#include <cstdint>
+#include <bitset>
+
+/* Number of instructions kept in the trace, must be a power of two */
+const unsigned int TRACE_SIZE = 1024;
+
+/* Single executed instruction, written as is into the binary dump */
+struct TraceEntry
+{
+    uint16_t pc;
+    uint16_t opcode;
+    uint16_t index;
+    uint8_t sp;
+    /* Values of registers VX, VY and VF after execution */
+    uint8_t vx;
+    uint8_t vy;
+    uint8_t vf;
+    uint8_t pad[6];
+};
+
+class Tracer
+{
+public:
+    void Record(uint16_t pc, uint16_t opcode, uint16_t index, uint8_t sp,
+                uint8_t vx, uint8_t vy, uint8_t vf);
+
+    void AddWatchpoint(uint16_t address);
+    void RemoveWatchpoint(uint16_t address);
+    /* Check if the given memory write hits a watchpoint, report it if so */
+    void CheckWrite(uint16_t pc, uint16_t address, uint8_t value) {
+        if (watchpoints[address & 0x0FFF])
+            OnWatchpoint(pc, address, value);
+    }
+
+    bool Dump(const char* fileName) const;
+
+private:
+    void OnWatchpoint(uint16_t pc, uint16_t address, uint8_t value);
+
+private:
+    TraceEntry entries[TRACE_SIZE] { };
+    /* Total number of recorded instructions, position of the next write is derived from it */
+    uint64_t count = 0;
+    std::bitset<4096> watchpoints;
+};
+
+
+#endif //CHIP8_EMULATOR_TRACER_H
@@ -0,0 +1,52 @@
+#ifndef CHIP8_EMULATOR_VERIFIER_H
+#define CHIP8_EMULATOR_VERIFIER_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include "Chip8.h"
+#include "Tracer.h"
+
+/* Outcome of a lockstep run */
+struct VerifyResult
+{
+    bool passed = false;
+    /* Number of cycles both engines executed */
+    uint64_t cycles = 0;
+    /* Differences found at the first divergence, or the reason of failure */
+    std::string diff;
+};
+
+/* Runs the candidate engine side by side with the reference interpreter and compares them */
+class Verifier
+{
+public:
+    Verifier(const char* rom, unsigned int seed);
+
+    VerifyResult Run(uint64_t frames, bool everyInstruction);
+
+private:
+    std::string Compare();
+    std::string CompareRegisters() const;
+    std::string CompareFrame();
+    std::string CompareFlags();
+
+private:
+    /* Reference interpreter and the engine checked against it */
+    Chip8 reference;
+    Chip8 candidate;
+
+    /* Snapshots of both engines, used to compare memory and screen */
+    Chip8State referenceState { };
+    Chip8State candidateState { };
+
+    /* Recorder used by the candidate (traced) engine */
+    Tracer tracer;
+
+    /* Generator of the random, but repeatable keypad input */
+    std::mt19937 inputEng;
+    bool loaded;
+};
+
+
+#endif //CHIP8_EMULATOR_VERIFIER_H
@@ -1,8 +1,20 @@
 #include <thread>
 #include <iostream>
-#include <zconf.h>
+#include <csignal>
+#include <algorithm>
+#include <cmath>
 #include "includes/Chip8.h"
 #include "includes/Platform.h"
+#include "includes/Tracer.h"
+#include "includes/SpeedControl.h"
+
+/* Set by the signal handler, trace is dumped from the main loop */
+static volatile std::sig_atomic_t dumpRequested = 0;
+
+/* Request trace dump on SIGUSR1 */
+static void RequestDump(int) {
+    dumpRequested = 1;
+}
 
 int main(int argc, char* args[]) {
     /* Video scale factor */
@@ -11,6 +23,15 @@ int main(int argc, char* args[]) {
     /* Time delay */
     int delay = 1858;
 
+    /* Speed multiplier, 0 runs as fast as the host allows */
+    double speed = 1;
+
+    /* Present only every Nth emulated frame */
+    int frameSkip = 1;
+
+    /* Present once per host vsync */
+    bool vsync = false;
+
     /* Check if there is correct number of arguments, if not tell the user */
     if (argc <= 1) {
         std::cout << "Path to ROM need to be specified as an argument, "
@@ -22,7 +43,14 @@ int main(int argc, char* args[]) {
         std::cout << "Normal usage Chip8_Emulator <ROM>\n"
                "Flags:\n"
                "1: -d <value> for custom delay(default: 1500)\n"
-               "2: -s <value> for custom video scale(default: 10)\n" << std::endl;
+               "2: -s <value> for custom video scale(default: 10)\n"
+               "3: --trace <file> to record executed instructions, dumped on the first fault or on SIGUSR1\n"
+               "   (faults: unknown opcode, call with full stack, return with empty stack; these are ignored)\n"
+               "4: -w <hex address> to report memory writes at the address (needs --trace)\n"
+               "5: -x <value> for custom speed multiplier from 1/64 to 1024, max or 0 runs as fast as possible(default: 1)\n"
+               "6: --turbo to run as fast as possible, same as -x max\n"
+               "7: -k <value> to present only every Nth frame(default: 1)\n"
+               "8: -v to present once per host vsync\n" << std::endl;
         std::exit(EXIT_SUCCESS);
     }
 
@@ -36,6 +64,10 @@ int main(int argc, char* args[]) {
         std::exit(EXIT_FAILURE);
     }
 
+    /* Trace recorder and path of its dump, tracing is off without it */
+    Tracer tracer;
+    const char* traceFile = nullptr;
+
     /* Flags are specified */
     if (argc > 2) {
         /* Go through each argument not counting the ROM */
@@ -61,38 +93,141 @@ int main(int argc, char* args[]) {
                     std::exit(EXIT_FAILURE);
                 }
             }
+
+            /* If --trace flag is called, set the trace dump file */
+            else if (strcmp("--trace", args[i]) == 0) {
+                if (++i < argc) {
+                    traceFile = args[i];
+                }
+                else {
+                    printf("Trace file wasn't specified!");
+                    std::exit(EXIT_FAILURE);
+                }
+            }
+
+            /* If -w flag is called, add the watchpoint */
+            else if (strcmp("-w", args[i]) == 0) {
+                if (++i < argc) {
+                    tracer.AddWatchpoint(static_cast<uint16_t>(strtol(args[i], nullptr, 16)));
+                }
+                else {
+                    printf("Watchpoint address wasn't specified!");
+                    std::exit(EXIT_FAILURE);
+                }
+            }
+
+            /* If -x flag is called, set the speed multiplier */
+            else if (strcmp("-x", args[i]) == 0) {
+                if (++i < argc) {
+                    /* Only max or 0 runs uncapped, anything else has to be a positive number */
+                    char* end = nullptr;
+                    speed = strcmp("max", args[i]) == 0 ? 0 : strtod(args[i], &end);
+                    if (end && (end == args[i] || *end != '\0' || !std::isfinite(speed) || speed < 0)) {
+                        printf("Speed multiplier has to be a positive number, 0 or max!");
+                        std::exit(EXIT_FAILURE);
+                    }
+
+                    /* Keep a capped speed in the range the speed control supports */
+                    if (speed > 0)
+                        speed = std::clamp(speed, MIN_SPEED, MAX_SPEED);
+                }
+                else {
+                    printf("Speed multiplier wasn't specified!");
+                    std::exit(EXIT_FAILURE);
+                }
+            }
+
+            /* If --turbo flag is called, run as fast as possible */
+            else if (strcmp("--turbo", args[i]) == 0)
+                speed = 0;
+
+            /* If -k flag is called, set the frame skip value */
+            else if (strcmp("-k", args[i]) == 0) {
+                if (++i < argc) {
+                    frameSkip = std::max(atoi(args[i]), 1);
+                }
+                else {
+                    printf("Frame skip value wasn't specified!");
+                    std::exit(EXIT_FAILURE);
+                }
+            }
+
+            /* If -v flag is called, present on host vsync */
+            else if (strcmp("-v", args[i]) == 0)
+                vsync = true;
         }
     }
 
+    /* Switch the emulator to the traced engine only when requested */
+    if (traceFile) {
+        emu.EnableTrace(&tracer);
+        std::signal(SIGUSR1, RequestDump);
+    }
+
     /* Initialize platform (I/O processing) */
     Platform platform("CHIP8", static_cast<int>(VIDEO_WIDTH * scale),
-                      static_cast<int>(VIDEO_HEIGHT * scale), VIDEO_WIDTH, VIDEO_HEIGHT);
+                      static_cast<int>(VIDEO_HEIGHT * scale), VIDEO_WIDTH, VIDEO_HEIGHT, vsync);
 
     /* Set pitch of output */
     int pitch = sizeof(emu.video[0]) * VIDEO_WIDTH;
 
-    /* Prepare last cycle time */
-    auto lastTime = std::chrono::high_resolution_clock ::now();
+    /* Keep the emulation at the normal frame rate (given by the delay of each cycle) times the multiplier */
+    SpeedControl speedControl(1000000.0 / (std::max(delay, 1) * CYCLES_PER_FRAME), speed);
+
+    /* Emulated frames since the last presented one */
+    int framesSincePresent = 0;
+
+    /* Set once a fault was dumped, later faults don't overwrite the dump until SIGUSR1 */
+    bool faultDumped = false;
+
+    /* State of the keypad, updated by input events */
+    uint8_t keys[16] { };
 
     /* Quit flag */
     bool quit = false;
-    /* Emulate until quit is requested */
+    /* Emulate until quit is requested, each host frame runs as many frames as the speed control asks for */
     while (!quit) {
-        /* Process keys, check if the user wants to quit */
-        quit = Platform::ProcessInput(emu.keys);
+        /* Process keys once per host frame, check if the user wants to quit */
+        quit = Platform::ProcessInput(keys);
+
+        unsigned int framesDue = speedControl.FramesDue();
+        unsigned int frames = 0;
+        while (frames < framesDue) {
+            /* Latch the key state, so every opcode in this frame sees the same keys */
+            emu.LatchKeys(keys);
 
-        /* Emulate current opcode */
-        emu.Cycle();
+            /* Emulate opcodes of this frame */
+            for (unsigned int i = 0; i < CYCLES_PER_FRAME; ++i)
+                emu.Cycle();
+            ++frames;
+
+            /* Stop the batch on a fault that will be dumped, before the trace ring buffer overwrites it */
+            if (traceFile && emu.fault && !faultDumped)
+                break;
+        }
+        framesSincePresent += static_cast<int>(frames);
+
+        /* Adjust the speed to the time emulation took */
+        speedControl.FramesDone(frames);
+
+        /* Dump the trace on the first fault or when it was requested, the request also re-arms fault dumps */
+        if (traceFile && ((emu.fault && !faultDumped) || dumpRequested)) {
+            if (!tracer.Dump(traceFile))
+                printf("ERROR: Trace couldn't be written!\n");
+            faultDumped = !dumpRequested;
+            dumpRequested = 0;
+        }
+        emu.fault = false;
 
-        /* Update output based on set pixels in emulator */
-        if (emu.drawFlag) {
+        /* Update output based on set pixels in emulator, skip frames if requested */
+        if (emu.drawFlag && framesSincePresent >= frameSkip) {
             platform.Update(emu.video, pitch);
             emu.drawFlag = false;
+            framesSincePresent = 0;
         }
 
-        /* Sleep for delay time */
-        usleep(delay); /* usleep is more precise than sleep_for */
-        //std::this_thread::sleep_for(std::chrono::microseconds(delay));
+        /* Sleep until the next frame is due */
+        speedControl.Wait();
     }
 
     return 0;
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <cstring>
+#include "includes/Server.h"
+
+int main(int argc, char* args[]) {
+    /* Path of the socket clients connect to */
+    const char* socketPath = "/tmp/chip8.sock";
+
+    /* Name of the shared memory segment with framebuffers */
+    const char* shmName = "/chip8_frames";
+
+    /* Check if the user asks for help */
+    if (argc > 1 && strcmp(args[1], "--help") == 0) {
+        std::cout << "Normal usage Chip8_Server\n"
+                     "Flags:\n"
+                     "1: -u <path> for custom socket path(default: /tmp/chip8.sock)\n"
+                     "2: -m <name> for custom shared memory name(default: /chip8_frames)\n"
+                     "Requests (one per line, answered with OK or ERR line):\n"
+                     "OPEN <ROM>, LOAD <id> <ROM>, STEP <id> <frames>, KEYS <id> <hex mask>,\n"
+                     "SNAPSHOT <id>, RESTORE <id>, STATE <id>, CLOSE <id>, SHUTDOWN" << std::endl;
+        std::exit(EXIT_SUCCESS);
+    }
+
+    /* Go through each flag */
+    for (int i = 1; i < argc; i++) {
+        /* If -u flag is called, set the socket path */
+        if (strcmp("-u", args[i]) == 0) {
+            if (++i < argc) {
+                socketPath = args[i];
+            }
+            else {
+                printf("Socket path wasn't specified!");
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        /* If -m flag is called, set the shared memory name */
+        else if (strcmp("-m", args[i]) == 0) {
+            if (++i < argc) {
+                shmName = args[i];
+            }
+            else {
+                printf("Shared memory name wasn't specified!");
+                std::exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    /* Serve sessions until shutdown is requested */
+    Server server(socketPath, shmName);
+    server.Run();
+
+    return 0;
+}
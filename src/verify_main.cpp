@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "includes/Verifier.h"
+
+int main(int argc, char* args[]) {
+    /* Number of frames emulated for each ROM */
+    uint64_t frames = 100000;
+
+    /* Seed of the random input and random opcode */
+    unsigned int seed = 1;
+
+    /* Compare registers after every instruction, not only after every frame */
+    bool everyInstruction = true;
+
+    /* Check if there is at least one ROM, if not tell the user */
+    if (argc <= 1) {
+        std::cout << "Path to ROM need to be specified as an argument, "
+                     "see --help for usage information" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    /* Check if the user asks for help */
+    if (strcmp(args[1], "--help") == 0) {
+        std::cout << "Normal usage Chip8_Verify <ROM> [<ROM>...]\n"
+                     "Runs the candidate engine in lockstep with the reference interpreter,\n"
+                     "each ROM in its own thread, stops on the first divergence\n"
+                     "Flags:\n"
+                     "1: -n <value> for custom number of frames(default: 100000)\n"
+                     "2: -r <value> for custom seed(default: 1)\n"
+                     "3: -f to compare only once per frame\n" << std::endl;
+        std::exit(EXIT_SUCCESS);
+    }
+
+    /* Go through each argument, everything that isn't a flag is a ROM */
+    std::vector<const char*> roms;
+    for (int i = 1; i < argc; i++) {
+        /* If -n flag is called, set the number of frames */
+        if (strcmp("-n", args[i]) == 0) {
+            if (++i < argc) {
+                frames = strtoull(args[i], nullptr, 10);
+            }
+            else {
+                printf("Number of frames wasn't specified!");
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        /* If -r flag is called, set the seed */
+        else if (strcmp("-r", args[i]) == 0) {
+            if (++i < argc) {
+                seed = static_cast<unsigned int>(strtoul(args[i], nullptr, 10));
+            }
+            else {
+                printf("Seed wasn't specified!");
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        /* If -f flag is called, compare once per frame */
+        else if (strcmp("-f", args[i]) == 0)
+            everyInstruction = false;
+
+        else
+            roms.push_back(args[i]);
+    }
+
+    /* Verify each ROM in parallel */
+    std::vector<VerifyResult> results(roms.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < roms.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            Verifier verifier(roms[i], seed);
+            results[i] = verifier.Run(frames, everyInstruction);
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    /* Report results, fail if any engine diverged */
+    bool passed = true;
+    for (size_t i = 0; i < roms.size(); ++i) {
+        if (results[i].passed)
+            printf("PASS %s: %llu cycles\n", roms[i], static_cast<unsigned long long>(results[i].cycles));
+        else {
+            printf("FAIL %s: cycle %llu:%s\n", roms[i], static_cast<unsigned long long>(results[i].cycles),
+                   results[i].diff.c_str());
+            passed = false;
+        }
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}